@@ -40,6 +40,14 @@
 #ifndef BINDGEN_HELPER_HPP
 #define BINDGEN_HELPER_HPP
 
+// Registering foreign threads needs the thread API of the GC.
+#if defined(BINDGEN_FOREIGN_THREADS) && !defined(GC_THREADS)
+#ifdef GC_H
+#error "Define GC_THREADS with BINDGEN_FOREIGN_THREADS, or include this file before gc.h"
+#endif
+#define GC_THREADS
+#endif
+
 #include <gc/gc.h> // Boehm GC
 #include <string.h>
 #include <stdlib.h> // abort()
@@ -62,6 +70,8 @@ static __attribute__((noreturn)) void bindgen_fatal_panic(const char *message) {
 #ifdef __cplusplus
 #include <gc/gc_cpp.h>
 #include <string>
+#include <type_traits>
+#include <utility> // std::move
 
 // Break C++'s encapsulation to allow easy wrapping of protected methods.
 #define protected public
@@ -104,12 +114,23 @@ struct CrystalProc {
   }
 };
 
-template <typename T>
+/* Wrapper for instances created from Crystal.  If `T` has a non-trivial
+ * destructor, a finalizer is registered to run it once the GC collects the
+ * object.  Trivially destructible types skip the (expensive) finalizer
+ * registration entirely, and are reclaimed in the same collection cycle.
+ */
+template <typename T, bool Trivial = std::is_trivially_destructible<T>::value>
 struct CrystalGCWrapper: public T, public gc_cleanup
 {
   using T::T;
 };
 
+template <typename T>
+struct CrystalGCWrapper<T, true>: public T, public gc
+{
+  using T::T;
+};
+
 /// A simple wrapper around a non-pointer type that allows a single
 /// dereference operation.
 template <typename T>
@@ -122,5 +143,633 @@ struct bg_deref {
   T operator*() && { return std::move(data); }
 };
 
+/* Call profiling of the wrappers.  Build the bindings with `-DBINDGEN_PROFILE`
+ * to have every wrapper function and virtual forwarder count its calls, and
+ * the CPU cycles spent in it (Including nested calls).  Each thread counts
+ * into its own counters, which are merged when it exits.  Without the switch,
+ * `bindgen_profile_call` expands to nothing.
+ *
+ * Call `bindgen_profile_report` to print the hottest wrappers to `stderr`, or
+ * set the `BINDGEN_PROFILE_REPORT` environment variable to do so at exit.
+ * `bindgen_profile_calls` returns the call count of a single wrapper.
+ */
+#ifdef BINDGEN_PROFILE
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc()
+#else
+#include <chrono>
+#endif
+
+namespace bindgen_profile {
+  static inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+  }
+
+  inline void print_report(int limit);
+
+  /* A profiled function.  Holds the counters of all exited threads. */
+  struct Site {
+    const char *name;
+    int id;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> cycles;
+    Site *next;
+
+    Site(const char *name);
+  };
+
+  /* All sites, as lock-free stack. */
+  inline std::atomic<Site *> &sites() {
+    static std::atomic<Site *> head(nullptr);
+    return head;
+  }
+
+  inline Site::Site(const char *name) : name(name), calls(0), cycles(0) {
+    static std::atomic<int> count(0);
+    id = count++;
+
+    if (id == 0 && getenv("BINDGEN_PROFILE_REPORT")) {
+      atexit([]{ print_report(0); });
+    }
+
+    next = sites().load();
+    while (!sites().compare_exchange_weak(next, this)) { }
+  }
+
+  /* Counters of a single thread, indexed by `Site::id`. */
+  struct ThreadCounters {
+    struct Counter {
+      uint64_t calls;
+      uint64_t cycles;
+    };
+
+    std::vector<Counter> counters;
+
+    ~ThreadCounters() {
+      merge();
+    }
+
+    Counter &at(int id) {
+      if (static_cast<size_t>(id) >= counters.size()) {
+        counters.resize(id + 1, Counter{ 0, 0 });
+      }
+
+      return counters[id];
+    }
+
+    /* Moves the counts into the sites. */
+    void merge() {
+      for (Site *site = sites().load(); site; site = site->next) {
+        if (static_cast<size_t>(site->id) >= counters.size()) continue;
+
+        Counter &counter = counters[site->id];
+        site->calls += counter.calls;
+        site->cycles += counter.cycles;
+        counter = Counter{ 0, 0 };
+      }
+    }
+  };
+
+  inline ThreadCounters &thread_counters() {
+    static thread_local ThreadCounters counters;
+    return counters;
+  }
+
+  /* Counts the time from its construction to its destruction. */
+  struct Scope {
+    int id;
+    uint64_t start;
+
+    Scope(const Site &site) : id(site.id), start(now()) { }
+
+    ~Scope() {
+      // Look up the counter again, a nested call may have grown the list.
+      ThreadCounters::Counter &counter = thread_counters().at(id);
+      counter.calls++;
+      counter.cycles += now() - start;
+    }
+  };
+
+  /* Prints the merged counters, hottest first.  Prints all sites if *limit* is
+   * zero. */
+  inline void print_report(int limit) {
+    std::vector<Site *> list;
+    for (Site *site = sites().load(); site; site = site->next) {
+      if (site->calls > 0) list.push_back(site);
+    }
+
+    std::sort(list.begin(), list.end(), [](Site *l, Site *r) {
+      return l->cycles > r->cycles;
+    });
+
+    if (limit > 0 && list.size() > static_cast<size_t>(limit)) {
+      list.resize(limit);
+    }
+
+    fprintf(stderr, "%12s %16s %12s  %s\n", "Calls", "Cycles", "Cycles/Call", "Wrapper");
+    for (Site *site : list) {
+      uint64_t calls = site->calls, cycles = site->cycles;
+      fprintf(stderr, "%12llu %16llu %12llu  %s\n",
+              static_cast<unsigned long long>(calls),
+              static_cast<unsigned long long>(cycles),
+              static_cast<unsigned long long>(cycles / calls),
+              site->name);
+    }
+  }
+}
+
+/* Prints the *limit* hottest wrappers to `stderr`, or all if *limit* is zero.
+ * Includes the calls of the current thread and of all exited threads. */
+extern "C" __attribute__((used)) inline void bindgen_profile_report(int limit) {
+  bindgen_profile::thread_counters().merge();
+  bindgen_profile::print_report(limit);
+}
+
+/* Returns how often the wrapper *name* was called, including the calls of the
+ * current thread and of all exited threads. */
+extern "C" __attribute__((used)) inline uint64_t bindgen_profile_calls(const char *name) {
+  bindgen_profile::thread_counters().merge();
+
+  uint64_t calls = 0;
+  for (bindgen_profile::Site *site = bindgen_profile::sites().load(); site; site = site->next) {
+    if (strcmp(site->name, name) == 0) calls += site->calls;
+  }
+
+  return calls;
+}
+
+#define bindgen_profile_call(name) \
+  static bindgen_profile::Site bindgen_profile_site_(name); \
+  bindgen_profile::Scope bindgen_profile_scope_(bindgen_profile_site_)
+#else
+#define bindgen_profile_call(name) ((void)0)
+#endif // BINDGEN_PROFILE
+
+/* Callbacks from foreign threads.  Calls from C++ into Crystal, like virtual
+ * method overrides and Qt signal handlers, are wrapped in `bindgen_callback`.
+ * By default, that does nothing, and the callback must happen on a thread
+ * created by Crystal.
+ *
+ * Build the bindings with `-DBINDGEN_FOREIGN_THREADS` to also allow callbacks
+ * from other threads, like the ones of a C++ thread pool.  Then call
+ * `bindgen_foreign_threads_init` once from the main thread of the Crystal
+ * program, passing the policy for callbacks arriving on foreign threads:
+ *
+ * - `BINDGEN_CALLBACK_INLINE` runs the callback right on the foreign thread.
+ *   Only safe for callbacks not using the Crystal scheduler, like fibers,
+ *   channels or IO.
+ * - `BINDGEN_CALLBACK_MARSHAL` queues the callback, and blocks the foreign
+ *   thread until the main thread ran it in `bindgen_foreign_threads_drain`.
+ *   The main thread has to call that regularly, also while waiting for the
+ *   work of a foreign thread to finish.  It must not block inside C++ on
+ *   such work, like in `QThreadPool::waitForDone` or `std::thread::join`, as
+ *   that deadlocks if the work calls back.  Use `BINDGEN_CALLBACK_INLINE`
+ *   there instead.
+ *
+ * With either policy, a foreign thread is registered with the GC on its first
+ * callback, and stays registered until it exits.  Its stack is thus scanned,
+ * so that the Crystal objects returned by a callback stay alive while the C++
+ * code uses them.  References returned by a callback are passed on as-is.
+ */
+#define BINDGEN_CALLBACK_INLINE 0
+#define BINDGEN_CALLBACK_MARSHAL 1
+
+#ifdef BINDGEN_FOREIGN_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <memory> // std::addressof
+#include <mutex>
+
+namespace bindgen_threads {
+  /* How the current thread is treated. */
+  enum Kind {
+    UNKNOWN, // Not seen yet
+    CRYSTAL, // Created by Crystal, or the main thread
+    FOREIGN, // Created by C++, and registered with the GC
+  };
+
+  /* A queued callback.  Lives on the stack of the waiting foreign thread. */
+  struct Task {
+    void (*run)(void *);
+    void *callable;
+    bool done; // Guarded by `done_mutex()`
+    Task *next;
+  };
+
+  /* Unregisters the thread from the GC once it exits. */
+  struct Registration {
+    bool active = false;
+
+    ~Registration() {
+      if (active) GC_unregister_my_thread();
+    }
+  };
+
+  inline std::atomic<int> &policy() {
+    static std::atomic<int> value(-1); // Not initialized yet
+    return value;
+  }
+
+  /* Queued tasks, as lock-free stack.  Newest first. */
+  inline std::atomic<Task *> &queue() {
+    static std::atomic<Task *> head(nullptr);
+    return head;
+  }
+
+  /* Guards `Task::done`, and wakes up the waiting foreign threads. */
+  inline std::mutex &done_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  inline std::condition_variable &done_signal() {
+    static std::condition_variable signal;
+    return signal;
+  }
+
+  inline Kind &thread_kind() {
+    static thread_local Kind kind = UNKNOWN;
+    return kind;
+  }
+
+  /* Finds out how to treat the current thread, registering it with the GC if
+   * it's a foreign thread.  A marshalling thread is registered too, so that
+   * the GC sees the results it receives. */
+  inline Kind classify_thread() {
+    static thread_local Registration registration;
+
+    if (GC_thread_is_registered()) return CRYSTAL;
+
+    if (policy().load() < 0) {
+      bindgen_fatal_panic("Callback from a foreign thread before bindgen_foreign_threads_init()");
+    }
+
+    struct GC_stack_base base;
+    GC_get_stack_base(&base);
+    GC_register_my_thread(&base);
+    registration.active = true;
+
+    return FOREIGN;
+  }
+
+  /* Storage of the result of a marshalled callback. */
+  template<typename T>
+  struct Result {
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    template<typename F>
+    void run(F &func) { new (storage) T(func()); }
+
+    T take() {
+      T *value = reinterpret_cast<T *>(storage);
+      T result(std::move(*value));
+      value->~T();
+      return result;
+    }
+  };
+
+  /* References are kept as pointer to the referenced object. */
+  template<typename T>
+  struct Result<T &> {
+    T *pointer;
+
+    template<typename F>
+    void run(F &func) { pointer = std::addressof(func()); }
+
+    T &take() { return *pointer; }
+  };
+
+  template<typename T>
+  struct Result<T &&> {
+    T *pointer;
+
+    template<typename F>
+    void run(F &func) {
+      T &&value = func();
+      pointer = std::addressof(value);
+    }
+
+    T &&take() { return std::move(*pointer); }
+  };
+
+  template<>
+  struct Result<void> {
+    template<typename F>
+    void run(F &func) { func(); }
+
+    void take() { }
+  };
+
+  /* Queues *func* for the main thread, and waits until it ran. */
+  template<typename F>
+  auto marshal(F &func) -> decltype(func()) {
+    typedef decltype(func()) T;
+    struct Closure {
+      F &func;
+      Result<T> result;
+    } closure{ func, Result<T>() };
+
+    Task task;
+    task.run = [](void *ptr) {
+      Closure *self = static_cast<Closure *>(ptr);
+      self->result.run(self->func);
+    };
+    task.callable = &closure;
+    task.done = false;
+
+    task.next = queue().load();
+    while (!queue().compare_exchange_weak(task.next, &task)) { }
+
+    {
+      std::unique_lock<std::mutex> lock(done_mutex());
+      done_signal().wait(lock, [&task]() { return task.done; });
+    }
+
+    return closure.result.take();
+  }
+
+  /* Runs the callback *func* according to the policy. */
+  template<typename F>
+  inline auto dispatch(F func) -> decltype(func()) {
+    Kind &kind = thread_kind();
+    if (bindgen_likely(kind == CRYSTAL)) return func();
+    if (kind == UNKNOWN) kind = classify_thread();
+    if (kind == CRYSTAL || policy().load() == BINDGEN_CALLBACK_INLINE) return func();
+
+    return marshal(func);
+  }
+}
+
+/* Allows callbacks from foreign threads, handled as set by *policy*.  Call
+ * this once from the main thread of the Crystal program. */
+extern "C" __attribute__((used)) inline void bindgen_foreign_threads_init(int policy) {
+  GC_allow_register_threads();
+  bindgen_threads::policy().store(policy);
+}
+
+/* Runs the callbacks queued by foreign threads, and returns how many ran.  Call
+ * this regularly from the main thread if using `BINDGEN_CALLBACK_MARSHAL`. */
+extern "C" __attribute__((used)) inline int bindgen_foreign_threads_drain() {
+  using bindgen_threads::Task;
+
+  // Take all tasks, and reverse them to run in order of arrival.
+  Task *task = bindgen_threads::queue().exchange(nullptr);
+  Task *ordered = nullptr;
+  while (task) {
+    Task *next = task->next;
+    task->next = ordered;
+    ordered = task;
+    task = next;
+  }
+
+  int count = 0;
+  while (ordered) {
+    Task *next = ordered->next; // The task is gone once done.
+    ordered->run(ordered->callable);
+
+    {
+      std::lock_guard<std::mutex> lock(bindgen_threads::done_mutex());
+      ordered->done = true;
+    }
+
+    ordered = next;
+    count++;
+  }
+
+  if (count > 0) bindgen_threads::done_signal().notify_all();
+  return count;
+}
+
+// The lambda returns references as such, not as copy of the referenced value.
+#define bindgen_callback(...) bindgen_threads::dispatch([&]() -> decltype((__VA_ARGS__)) { return (__VA_ARGS__); })
+#else
+#define bindgen_callback(...) (__VA_ARGS__)
+#endif // BINDGEN_FOREIGN_THREADS
+
+/* Batched wrapper calls, as generated for the methods matching the
+ * `batch_methods` of a type.  Crystal appends each call as a command to a
+ * buffer, which the trampoline of the class runs in a single call.  Each
+ * value of a command takes a slot the size of a pointer. */
+template<typename T>
+inline T bindgen_batch_read(void **&cursor) {
+  static_assert(sizeof(T) <= sizeof(void *), "Value doesn't fit into a command slot");
+  typename std::remove_const<T>::type value;
+  memcpy(&value, cursor++, sizeof(T));
+  return value;
+}
+
+/* Asynchronous wrapper calls, as generated for the methods matching the
+ * `async_methods` of a type.  The wrapper hands the call to
+ * `bindgen_async_run`, which writes a byte into the pipe *fd* once the call is
+ * done.  The Crystal side waits for that byte in its event loop, so that only
+ * the awaiting fiber is suspended.
+ *
+ * Build the bindings with `-DBINDGEN_ASYNC` to run the calls on a pool of
+ * worker threads.  The pool has a thread per core, or as many threads as set
+ * in the `BINDGEN_ASYNC_THREADS` environment variable.  Without it, the calls
+ * run right away on the calling thread, blocking it like a common call.
+ */
+#include <errno.h>
+#include <unistd.h> // write()
+
+#ifdef BINDGEN_ASYNC
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace bindgen_async {
+  /* Tells the waiting Crystal fiber that the call is done. */
+  inline void notify(int fd) {
+    char byte = 1;
+    while (write(fd, &byte, 1) < 0 && errno == EINTR) { }
+  }
+
+#ifdef BINDGEN_ASYNC
+  /* Worker threads, taking the calls in order of arrival. */
+  struct Pool {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> tasks;
+
+    Pool() {
+      const char *env = getenv("BINDGEN_ASYNC_THREADS");
+      int count = env ? atoi(env) : (int)std::thread::hardware_concurrency();
+      if (count < 1) count = 1;
+
+      for (int i = 0; i < count; i++) {
+        std::thread([this]() { work(); }).detach();
+      }
+    }
+
+    void work() {
+      for (;;) {
+        std::function<void()> task;
+
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          ready.wait(lock, [this]() { return !tasks.empty(); });
+          task = std::move(tasks.front());
+          tasks.pop_front();
+        }
+
+        task();
+      }
+    }
+
+    void submit(std::function<void()> task) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+      }
+
+      ready.notify_one();
+    }
+  };
+
+  /* The pool, started on first use.  Never destroyed, as its threads may
+   * still be running when the program exits. */
+  inline Pool &pool() {
+    static Pool *instance = new Pool;
+    return *instance;
+  }
+#endif // BINDGEN_ASYNC
+}
+
+/* Runs *func*, and notifies *fd* once done. */
+template<typename F>
+inline void bindgen_async_run(int fd, F func) {
+#ifdef BINDGEN_ASYNC
+  bindgen_async::pool().submit([fd, func]() {
+    func();
+    bindgen_async::notify(fd);
+  });
+#else
+  func();
+  bindgen_async::notify(fd);
+#endif
+}
+
+/* Coalesced Qt signal connections, as generated for the signals matching the
+ * `coalesce_signals` or `accumulate_signals` of a type.  An emission only
+ * stores a copy of its arguments, and schedules a delivery if none is pending
+ * yet.  The delivery converts the stored arguments, and calls the Crystal
+ * handler:
+ *
+ * - `bindgen_coalesce_latest` keeps only the latest emission, and calls the
+ *   handler with its arguments.
+ * - `bindgen_coalesce_accumulate` keeps all emissions, and calls the handler
+ *   for each, passing `true` as extra last argument to the final one.
+ *
+ * The *schedule* function gets the delivery, and runs it later.  For Qt, that's
+ * `QMetaObject::invokeMethod` with a `Qt::QueuedConnection`, delivering once
+ * per event-loop iteration.
+ */
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bindgen_coalesce {
+  /* Emissions waiting for their delivery.  Shared by the connection and the
+   * scheduled delivery.  Emissions may come from other threads. */
+  class Queue {
+  public:
+    /* Stores *emission*, replacing the stored ones unless *accumulate* is
+     * true.  Returns `true` if a delivery has to be scheduled. */
+    bool push(std::function<void(bool)> emission, bool accumulate) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!accumulate) emissions.clear();
+      emissions.push_back(std::move(emission));
+
+      if (pending) return false;
+      pending = true;
+      return true;
+    }
+
+    /* Runs the stored emissions, passing `true` to the last one. */
+    void deliver() {
+      std::vector<std::function<void(bool)>> ready;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(emissions);
+        pending = false;
+      }
+
+      for (size_t i = 0; i < ready.size(); i++) {
+        ready[i](i + 1 == ready.size());
+      }
+    }
+
+  private:
+    std::mutex mutex;
+    std::vector<std::function<void(bool)>> emissions;
+    bool pending = false;
+  };
+
+  /* Calls the handler of a delivered emission. */
+  template<bool Accumulate>
+  struct Invoke {
+    template<typename Handler, typename ... Args>
+    static void call(Handler &handler, bool, Args & ... args) {
+      handler(args...);
+    }
+  };
+
+  template<>
+  struct Invoke<true> {
+    template<typename Handler, typename ... Args>
+    static void call(Handler &handler, bool last, Args & ... args) {
+      handler(args..., last);
+    }
+  };
+
+  /* The functor connected to the signal. */
+  template<bool Accumulate, typename Schedule, typename Handler, typename ... Args>
+  struct Connection {
+    std::shared_ptr<Queue> queue;
+    Schedule schedule;
+    Handler handler;
+
+    void operator()(Args ... args) const {
+      Handler copy = handler;
+      auto emission = [copy, args...](bool last) mutable {
+        Invoke<Accumulate>::call(copy, last, args...);
+      };
+
+      if (queue->push(emission, Accumulate)) {
+        std::shared_ptr<Queue> target = queue;
+        schedule(std::function<void()>([target]() { target->deliver(); }));
+      }
+    }
+  };
+}
+
+/* Connects *handler* to the latest emission of a signal with *Args*. */
+template<typename ... Args, typename Schedule, typename Handler>
+inline bindgen_coalesce::Connection<false, Schedule, Handler, Args...>
+bindgen_coalesce_latest(Schedule schedule, Handler handler) {
+  return { std::make_shared<bindgen_coalesce::Queue>(), schedule, handler };
+}
+
+/* Connects *handler* to all emissions of a signal with *Args*. */
+template<typename ... Args, typename Schedule, typename Handler>
+inline bindgen_coalesce::Connection<true, Schedule, Handler, Args...>
+bindgen_coalesce_accumulate(Schedule schedule, Handler handler) {
+  return { std::make_shared<bindgen_coalesce::Queue>(), schedule, handler };
+}
+
 #endif // __cplusplus
 #endif // BINDGEN_HELPER_HPP
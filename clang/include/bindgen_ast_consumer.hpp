@@ -18,10 +18,13 @@ private:
 	clang::ast_matchers::MatchFinder makeBasicMatchFinder();
 	clang::ast_matchers::MatchFinder makeDependentMatchFinder();
 
-	void gatherTypeInfo(clang::ASTContext &ctx);
 	void evaluateMacros(clang::ASTContext &ctx);
 	void serializeAndOutput();
 
+	void streamDeclarations();
+	void streamOperators();
+	void streamMacros();
+
 	clang::CompilerInstance &m_compiler;
 	std::vector<std::unique_ptr<RecordMatchHandler>> m_classHandlers;
 	std::vector<std::unique_ptr<OperatorMatchHandler>> m_operatorHandlers;
@@ -30,6 +33,7 @@ private:
 	Document &m_document;
 	clang::ast_matchers::MatchFinder::MatchFinderOptions m_matchFinderOpts;
 	std::vector<clang::ast_matchers::MatchFinder> m_matchFinders;
+	std::map<std::string, size_t> m_streamedMethodCounts; // Method count of each class when streamed
 };
 
 #endif // BINDGEN_AST_CONSUMER_HPP
@@ -117,6 +117,16 @@ public:
 		return it != m_map.end() ? &it->second : nullptr;
 	}
 
+	const V *at(const K &key) const {
+		auto it = m_map.find(key);
+		return it != m_map.end() ? &it->second : nullptr;
+	}
+
+	// Keys in insertion order.
+	const std::vector<K> &keys() const {
+		return m_keys;
+	}
+
 	JsonStream &toJson(JsonStream &s) const {
 		bool first = true;
 		s << JsonStream::ObjectBegin;
@@ -0,0 +1,48 @@
+#ifndef PARSER_STATS_HPP
+#define PARSER_STATS_HPP
+
+#include "json_stream.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/* Collects timings, peak memory usage and counters of the parser phases.  The
+ * result is only written if requested through `-stats-out`. */
+class ParserStats {
+public:
+	struct Phase {
+		int64_t durationNs = 0; // Wall-clock time spent in the phase
+		int64_t peakRss = 0; // Peak resident set size after the phase, in bytes
+		int64_t rssGrowth = 0; // Growth of the peak RSS during the phase
+	};
+
+	static ParserStats &instance();
+
+	// Are statistics requested?
+	bool isEnabled() const;
+
+	// Starts the phase *name*, ending the current one if any.
+	void begin(const std::string &name);
+
+	// Ends the current phase, if any.
+	void end();
+
+	// Adds *amount* to the counter *name*.
+	void count(const std::string &name, int64_t amount = 1);
+
+	// Writes the statistics into the `-stats-out` file, if requested.
+	void write();
+
+private:
+	ParserStats();
+
+	JsonMap<std::string, Phase> m_phases;
+	JsonMap<std::string, int64_t> m_counters;
+	std::string m_current;
+	std::chrono::steady_clock::time_point m_start;
+	int64_t m_startRss = 0;
+};
+
+JsonStream &operator<<(JsonStream &s, const ParserStats::Phase &value);
+
+#endif // PARSER_STATS_HPP
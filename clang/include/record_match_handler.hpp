@@ -3,7 +3,7 @@
 
 class RecordMatchHandler : public clang::ast_matchers::MatchFinder::MatchCallback {
 public:
-	RecordMatchHandler(Document &doc, const std::string &name);
+	RecordMatchHandler(Document &doc, clang::CompilerInstance &compiler, const std::string &name);
 
 	virtual void run(const clang::ast_matchers::MatchFinder::MatchResult &Result) override;
 
@@ -12,6 +12,16 @@ private:
 
 	bool runOnRecord(Class &klass, const clang::CXXRecordDecl *record);
 
+	bool isDefaultConstructible(const clang::CXXRecordDecl *record);
+
+	bool isTriviallyDestructible(const clang::CXXRecordDecl *record);
+
+	bool hasPublicDestructor(const clang::CXXRecordDecl *record);
+
+	bool isPointerFree(const clang::CXXRecordDecl *record);
+
+	bool isPointerFree(clang::QualType qt);
+
 	bool runOnField(Field &f, const clang::FieldDecl *field);
 
 	bool runOnStaticField(Field &f, const clang::VarDecl *var);
@@ -24,6 +34,7 @@ private:
 
 private:
 	Document &m_document;
+	clang::CompilerInstance &m_compiler;
 	std::string m_className;
 
 	// first = record definition, second = qualified type name
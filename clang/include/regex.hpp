@@ -2,9 +2,31 @@
 #define REGEX_HPP
 
 #include <pcre.h>
+#include <set>
 #include <string>
+#include <unordered_set>
+
+// Set of literal strings, matching texts equal to or starting with any of them.
+class LiteralSet {
+public:
+  void add(const std::string &literal);
+
+  bool empty() const { return this->m_literals.empty(); }
+
+  bool isEqual(const std::string &text) const;
+  bool isPrefixOf(const std::string &text) const;
+
+private:
+  std::unordered_set<std::string> m_literals;
+  std::set<size_t> m_lengths; // Distinct lengths of all literals
+};
 
 // PCRE based regex helper.  Aborts if a regex is broken.
+//
+// Top-level alternatives like `^name$` and `^prefix` (Or `^prefix.*`) are
+// matched through hash sets instead, as the `-f` and `-m` options often get
+// thousands of these.  All other alternatives are matched by PCRE, using its
+// JIT compiler if available.
 class Regex {
 public:
   Regex(const std::string &expression);
@@ -14,8 +36,14 @@ public:
   bool isMatch(const std::string &text) const;
 
 private:
+  void compile(const std::string &expression);
+
   pcre *m_regex;
   pcre_extra *m_extra;
+
+  LiteralSet m_names; // Alternatives matching a whole text
+  LiteralSet m_prefixes; // Alternatives matching a text prefix
+  LiteralSet m_guards; // Literal prefixes of all alternatives left to PCRE
 };
 
 #endif // REGEX_HPP
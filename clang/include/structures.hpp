@@ -109,6 +109,8 @@ struct Method {
 	bool isVirtual = false; // Is this method virtual?
 	bool isPure = false; // Pure virtual?
 	bool isExternC = false; // Does the function use C ABI?
+	bool isExported = false; // Does the library export `symbolName`?
+	std::string symbolName; // Mangled symbol name, if exported.
 	std::string className; // Name of the class.
 	std::vector<Argument> arguments; // Arguments
 	int firstDefaultArgument = -1;
@@ -137,6 +139,7 @@ struct Field : public Type {
 	bool hasDefault = false; // Does this field have a default value?
 	LiteralData value; // Default value of the field
 	int bitField = -1;
+	int64_t offset = -1; // Offset in bytes in an instance, -1 if static
 };
 
 JsonStream &operator<<(JsonStream &s, const Field &value);
@@ -150,7 +153,12 @@ struct Class {
 	bool isDestructible = true; // Does this class have a public or protected destructor?
 	bool isAbstract; // Does the class have pure virtual methods?
 	bool isAnonymous; // Is this class anonymous?
+	bool isPointerFree = false; // Does an instance never contain any pointers?
+	bool isTriviallyCopyable = false; // Can an instance be copied with memcpy()?
+	bool isTriviallyDestructible = false; // Is the destructor trivial?
+	bool isStandardLayout = false; // Is the layout compatible to a C struct?
 	int byteSize; // Size of an instance in memory.
+	int alignment = 0; // Alignment of an instance in memory, in bytes.
 	std::string name; // Fully::qualified::class::name (anonymous classes also receive one for identification)
 	std::vector<BaseClass> bases; // Names of base classes
 	std::vector<Method> methods; // Methods
@@ -181,23 +189,28 @@ struct Macro {
 
 JsonStream &operator<<(JsonStream &s, const Macro &value);
 
-// type properties gathered from instantiations of `BindgenTypeInfo`
-struct TypeInfoResult {
-	bool isDefaultConstructible;
+// Memory layout of a class on one target.
+struct ClassLayout {
+	int byteSize = 0;
+	int alignment = 0;
 };
 
+JsonStream &operator<<(JsonStream &s, const ClassLayout &value);
+
+// Layout of the classes which differ on one target from the primary one.
+struct TargetLayout {
+	std::string triple; // The target triple
+	JsonMap<std::string, ClassLayout> classes;
+};
+
+JsonStream &operator<<(JsonStream &s, const TargetLayout &value);
+
 struct Document {
 	JsonMap<std::string, Enum> enums;
 	JsonMap<std::string, Class> classes;
 	std::vector<Method> functions;
 	std::vector<Macro> macros;
-
-	std::map<std::string, TypeInfoResult> type_infos; // not serialized
-
-	TypeInfoResult *findTypeInfoResult(const std::string &klass) {
-		auto it = type_infos.find(klass);
-		return it != type_infos.end() ? &it->second : nullptr;
-	}
+	std::vector<TargetLayout> targets; // Differences on secondary targets
 };
 
 JsonStream &operator<<(JsonStream &s, const Document &value);
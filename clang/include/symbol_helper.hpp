@@ -0,0 +1,16 @@
+#ifndef SYMBOL_HELPER_HPP
+#define SYMBOL_HELPER_HPP
+
+#include "structures.hpp"
+
+namespace clang {
+	class FunctionDecl;
+};
+
+namespace SymbolHelper {
+	// Sets `symbolName` and `isExported` of *m*, if *func* is defined
+	// out-of-line, so that the library exports its symbol.
+	void addSymbol(const clang::FunctionDecl *func, Method &m);
+};
+
+#endif // SYMBOL_HELPER_HPP
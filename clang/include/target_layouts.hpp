@@ -0,0 +1,44 @@
+#ifndef TARGET_LAYOUTS_HPP
+#define TARGET_LAYOUTS_HPP
+
+#include "structures.hpp"
+#include <string>
+#include <vector>
+
+/* Collects the memory layouts of the parsed classes when parsing for multiple
+ * targets.  Each secondary target is parsed first in a child process, which
+ * only collects the layout, and reports it to the parent through a pipe.  The
+ * primary target is parsed last, and the differences of the secondary targets
+ * to it are added to its document. */
+class TargetLayouts {
+public:
+	static TargetLayouts &instance();
+
+	// Starts parsing for the secondary target *triple*, reporting its layout
+	// into the file descriptor *fd*.
+	void beginSecondary(const std::string &triple, int fd);
+
+	// Adds the layout of the secondary target *triple*, as reported by its
+	// child process in *report*.
+	void addSecondary(const std::string &triple, const std::string &report);
+
+	// Starts parsing for the primary target.
+	void beginPrimary();
+
+	// Is a secondary target being parsed?
+	bool isSecondary() const;
+
+	// Called once the declarations of *doc* are known.  Reports the layout of
+	// a secondary target, or adds the differences to them to the primary *doc*.
+	void finishTarget(Document &doc);
+
+private:
+	static TargetLayout layoutOf(const Document &doc);
+	static TargetLayout difference(const TargetLayout &primary, const TargetLayout &secondary);
+
+	std::string m_current; // Triple of the secondary target being parsed
+	int m_output = -1; // Where to report the layout of the secondary target
+	std::vector<TargetLayout> m_secondaries;
+};
+
+#endif // TARGET_LAYOUTS_HPP
@@ -5,6 +5,12 @@
 #include "enum_match_handler.hpp"
 #include "bindgen_ast_consumer.hpp"
 #include "bindgen_frontend_action.hpp"
+#include "target_layouts.hpp"
+
+#include <cerrno>
+#include <cstdio> // perror()
+#include <sys/wait.h>
+#include <unistd.h>
 
 static llvm::cl::OptionCategory BindgenCategory("bindgen options");
 #if __clang_major__ >= 10
@@ -12,10 +18,73 @@ static const llvm::opt::OptTable& Options(clang::driver::getDriverOptTable());
 #else
 static std::unique_ptr<llvm::opt::OptTable> Options(clang::driver::createDriverOptTable());
 #endif
+static llvm::cl::list<std::string> Targets("targets", llvm::cl::desc("Target triples to parse for, the first one being the primary target"), llvm::cl::value_desc("triple"), llvm::cl::CommaSeparated);
 // See bindgen_ast_consumer.cpp for more
 
+// Parses for the secondary target *triple* in a child process, which reports
+// the layout of the classes through a pipe.  Clang crashes when tearing down a
+// run (See `BindgenASTConsumer::serializeAndOutput`), so the child exits
+// without that, just like the primary run does.  Returns the exit code.
+static int runSecondary(clang::tooling::ClangTool &tool, clang::tooling::FrontendActionFactory *factory, const std::string &triple) {
+	int fds[2];
+	if (pipe(fds) != 0) {
+		perror("pipe");
+		return 1;
+	}
+
+	pid_t child = fork();
+	if (child < 0) {
+		perror("fork");
+		return 1;
+	}
+
+	if (child == 0) {
+		close(fds[0]);
+		TargetLayouts::instance().beginSecondary(triple, fds[1]);
+		_exit(tool.run(factory));
+	}
+
+	close(fds[1]);
+	std::string report;
+	char buffer[4096];
+	ssize_t count;
+	while ((count = read(fds[0], buffer, sizeof(buffer))) != 0) {
+		if (count > 0) report.append(buffer, count);
+		else if (errno != EINTR) break;
+	}
+	close(fds[0]);
+
+	int status = 0;
+	while (waitpid(child, &status, 0) < 0 && errno == EINTR) { }
+	if (!WIFEXITED(status)) return 1;
+	if (WEXITSTATUS(status) != 0) return WEXITSTATUS(status);
+
+	TargetLayouts::instance().addSecondary(triple, report);
+	return 0;
+}
+
 int main(int argc, const char **argv) {
 	clang::tooling::CommonOptionsParser op(argc, argv, BindgenCategory);
 	clang::tooling::ClangTool tool(op.getCompilations(), op.getSourcePathList());
-	return tool.run(clang::tooling::newFrontendActionFactory<BindgenFrontendAction>().get());
+	auto factory = clang::tooling::newFrontendActionFactory<BindgenFrontendAction>();
+
+	std::string triple;
+	tool.appendArgumentsAdjuster([&triple](const clang::tooling::CommandLineArguments &args, llvm::StringRef) {
+		clang::tooling::CommandLineArguments result = args;
+		if (!triple.empty()) {
+			result.push_back("-target");
+			result.push_back(triple);
+		}
+		return result;
+	});
+
+	// Secondary targets go first, as the primary run outputs the document.
+	for (size_t i = 1; i < Targets.size(); i++) {
+		triple = Targets[i];
+		if (int result = runSecondary(tool, factory.get(), triple)) return result;
+	}
+
+	if (!Targets.empty()) triple = Targets[0];
+	TargetLayouts::instance().beginPrimary();
+	return tool.run(factory.get());
 }
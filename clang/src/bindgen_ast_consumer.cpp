@@ -10,15 +10,14 @@
 #include "enum_match_handler.hpp"
 #include "macro_ast_consumer.hpp"
 
-#include "type_helper.hpp"
-# if defined(__LLVM_VERSION_8)
-  #include "clang_type_name_llvm_8.hpp"
-# else
-  #include "clang_type_name.hpp"
-# endif
+#include "parser_stats.hpp"
+#include "target_layouts.hpp"
+
+#include <unistd.h> // _exit()
 
 static llvm::cl::list<std::string> ClassList("c", llvm::cl::desc("Classes to inspect"), llvm::cl::value_desc("class"));
 static llvm::cl::list<std::string> EnumList("e", llvm::cl::desc("Enums to inspect"), llvm::cl::value_desc("enum"));
+static llvm::cl::opt<bool> StreamOutput("ndjson", llvm::cl::desc("Stream the document as newline-delimited JSON records"));
 
 // we don't support `operator,` and `operator->*`
 AST_MATCHER(clang::FunctionDecl, isOverloadedOperator) {
@@ -48,9 +47,9 @@ clang::ast_matchers::MatchFinder BindgenASTConsumer::makeBasicMatchFinder() {
 		DeclarationMatcher classMatcher = cxxRecordDecl(isDefinition(), hasName(className)).bind("recordDecl");
 
 #if __clang_major__ >= 10
-		auto handler = std::make_unique<RecordMatchHandler>(m_document, className);
+		auto handler = std::make_unique<RecordMatchHandler>(m_document, m_compiler, className);
 #else
-		auto handler = make_unique<RecordMatchHandler>(m_document, className);
+		auto handler = make_unique<RecordMatchHandler>(m_document, m_compiler, className);
 #endif
 
 		finder.addMatcher(classMatcher, handler.get());
@@ -113,38 +112,39 @@ clang::ast_matchers::MatchFinder BindgenASTConsumer::makeDependentMatchFinder()
 }
 
 void BindgenASTConsumer::HandleTranslationUnit(clang::ASTContext &ctx) {
-	this->gatherTypeInfo(ctx);
-	for (auto &finder : this->m_matchFinders) {
-		finder.matchAST(ctx);
+	static const char *matchPhases[] = { "match basic", "match dependent" };
+	static const size_t matchPhaseCount = sizeof(matchPhases) / sizeof(*matchPhases);
+	ParserStats &stats = ParserStats::instance();
+
+	if (stats.isEnabled()) {
+		const clang::DeclContext *unit = ctx.getTranslationUnitDecl();
+		stats.count("decls.toplevel", std::distance(unit->decls_begin(), unit->decls_end()));
 	}
-  // FIXME: clang segfaults in 6 or newer when calling ParseAST in destructor
-	this->evaluateMacros(ctx);
-	this->serializeAndOutput();
-}
 
-static void runTypeInfoResult(TypeInfoResult &info, const clang::ClassTemplateSpecializationDecl *spec, clang::ASTContext &ctx) {
-	for (clang::Decl *decl : spec->decls()) {
-		if (auto var_decl = llvm::dyn_cast<clang::VarDecl>(decl)) {
-			if (var_decl->getName() == "isDefaultConstructible") {
-				LiteralData data;
-				TypeHelper::readValue(data, var_decl->getType(), ctx, var_decl->getInit());
-				info.isDefaultConstructible = data.container.bool_value;
-			}
+	for (size_t i = 0; i < this->m_matchFinders.size(); i++) {
+		stats.begin(i < matchPhaseCount ? matchPhases[i] : "match");
+		this->m_matchFinders[i].matchAST(ctx);
+
+		if (i == 0) {
+			TargetLayouts &targets = TargetLayouts::instance();
+			targets.finishTarget(this->m_document);
+			if (targets.isSecondary()) _exit(0); // Only the layout is needed, see serializeAndOutput()
 		}
-	}
-}
 
-void BindgenASTConsumer::gatherTypeInfo(clang::ASTContext &ctx) {
-	for (auto decl : ctx.getTranslationUnitDecl()->decls()) {
-		if (auto spec = llvm::dyn_cast<clang::ClassTemplateSpecializationDecl>(decl)) {
-			if (spec->getQualifiedNameAsString() == "BindgenTypeInfo") {
-				clang::QualType qt = spec->getTemplateArgs()[0].getAsType();
-				std::string fullName = ClangTypeName::getFullyQualifiedName(qt, ctx);
-				TypeInfoResult &info = m_document.type_infos[fullName];
-				runTypeInfoResult(info, spec, ctx);
-			}
+		// Classes, enums and functions are final after the basic pass, while
+		// the dependent pass only adds operators to known classes.
+		if (StreamOutput) {
+			if (i == 0) this->streamDeclarations();
+			else this->streamOperators();
 		}
 	}
+
+  // FIXME: clang segfaults in 6 or newer when calling ParseAST in destructor
+	stats.begin("evaluateMacros");
+	this->evaluateMacros(ctx);
+
+	stats.begin("serialize");
+	this->serializeAndOutput();
 }
 
 static std::string buildMacroEvaluationFile(const std::vector<Macro> &macros) {
@@ -172,10 +172,72 @@ void BindgenASTConsumer::evaluateMacros(clang::ASTContext &ctx) {
 	clang::ParseAST(this->m_compiler.getPreprocessor(), consumer, ctx);
 }
 
-void BindgenASTConsumer::serializeAndOutput() {
+// Writes a single line of the streamed document.
+template< typename T >
+static void writeRecord(const char *kind, const std::string &name, const T &value) {
 	JsonStream stream(std::cout);
-	stream << this->m_document;
+	auto c = JsonStream::Comma;
+
+	stream << JsonStream::ObjectBegin
+		<< std::make_pair("kind", kind) << c
+		<< std::make_pair("name", name) << c
+		<< std::make_pair("value", value)
+		<< JsonStream::ObjectEnd;
 	std::cout << std::endl;
+}
+
+void BindgenASTConsumer::streamDeclarations() {
+	for (const std::string &name : this->m_document.enums.keys()) {
+		writeRecord("enum", name, *this->m_document.enums.at(name));
+	}
+
+	for (const std::string &name : this->m_document.classes.keys()) {
+		const Class &klass = *this->m_document.classes.at(name);
+		this->m_streamedMethodCounts[name] = klass.methods.size();
+		writeRecord("class", name, klass);
+	}
+
+	for (const Method &function : this->m_document.functions) {
+		writeRecord("function", function.name, function);
+	}
+
+	for (const TargetLayout &target : this->m_document.targets) {
+		writeRecord("target", target.triple, target);
+	}
+
+	// Classes are still needed to attach operators to them.
+	this->m_document.enums = JsonMap<std::string, Enum>();
+	this->m_document.functions.clear();
+}
+
+void BindgenASTConsumer::streamOperators() {
+	for (const auto &pair : this->m_streamedMethodCounts) {
+		const Class &klass = *this->m_document.classes.at(pair.first);
+		if (klass.methods.size() <= pair.second) continue;
+
+		std::vector<Method> added(klass.methods.begin() + pair.second, klass.methods.end());
+		writeRecord("methods", pair.first, added);
+	}
+
+	this->m_document.classes = JsonMap<std::string, Class>();
+}
+
+void BindgenASTConsumer::streamMacros() {
+	for (const Macro &macro : this->m_document.macros) {
+		writeRecord("macro", macro.name, macro);
+	}
+}
+
+void BindgenASTConsumer::serializeAndOutput() {
+	if (StreamOutput) {
+		this->streamMacros();
+	} else {
+		JsonStream stream(std::cout);
+		stream << this->m_document;
+		std::cout << std::endl;
+	}
+
+	ParserStats::instance().write();
 
 	// FIXME: Currently the process crashes during clang's Parser destructor. This is a workaround.
 	exit(0);
@@ -4,6 +4,7 @@
 #include "bindgen_frontend_action.hpp"
 #include "bindgen_ast_consumer.hpp"
 #include "preprocessor_handler.hpp"
+#include "parser_stats.hpp"
 
 #include "clang/Lex/Preprocessor.h"
 
@@ -24,6 +25,8 @@ bool BindgenFrontendAction::BeginSourceFileAction(clang::CompilerInstance &ci, l
 bool BindgenFrontendAction::BeginSourceFileAction(clang::CompilerInstance &ci)
 #endif
 {
+	ParserStats::instance().begin("parse");
+
 	clang::Preprocessor &preprocessor = ci.getPreprocessor();
 	preprocessor.addPPCallbacks(make_unique<PreprocessorHandler>(this->m_document, preprocessor));
 	return true;
@@ -1,5 +1,6 @@
 #include "common.hpp"
 #include "enum_match_handler.hpp"
+#include "parser_stats.hpp"
 
 EnumMatchHandler::EnumMatchHandler(Document &doc, const std::string &name)
 	: m_document(doc), m_enumName(name)
@@ -7,6 +8,8 @@ EnumMatchHandler::EnumMatchHandler(Document &doc, const std::string &name)
 }
 
 void EnumMatchHandler::run(const clang::ast_matchers::MatchFinder::MatchResult &Result) {
+	ParserStats::instance().count("matches.enum");
+
 	const clang::EnumDecl *enumeration = Result.Nodes.getNodeAs<clang::EnumDecl>("enumDecl");
 	const clang::TypedefNameDecl *typeDecl = Result.Nodes.getNodeAs<clang::TypedefNameDecl>("typedefNameDecl");
 
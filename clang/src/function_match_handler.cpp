@@ -1,6 +1,8 @@
 #include "common.hpp"
 #include "function_match_handler.hpp"
+#include "parser_stats.hpp"
 #include "type_helper.hpp"
+#include "symbol_helper.hpp"
 
 static llvm::cl::opt<std::string> FunctionRegex("f", llvm::cl::desc("Functions to inspect"), llvm::cl::value_desc("function regex"));
 
@@ -14,6 +16,8 @@ bool FunctionMatchHandler::isActive() {
 }
 
 void FunctionMatchHandler::run(const clang::ast_matchers::MatchFinder::MatchResult &result) {
+	ParserStats::instance().count("matches.function");
+
 	const clang::FunctionDecl *func = result.Nodes.getNodeAs<clang::FunctionDecl>("functionDecl");
 	if (func) runOnFunction(func);
 }
@@ -45,6 +49,7 @@ static Method buildMethod(const clang::FunctionDecl *func, const std::string &fu
 	clang::ASTContext &ctx = func->getASTContext();
 	m.returnType = TypeHelper::qualTypeToType(func->getReturnType(), ctx);
 	TypeHelper::addFunctionParameters(func, m);
+	SymbolHelper::addSymbol(func, m);
 
 	return m;
 }
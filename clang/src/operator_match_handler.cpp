@@ -1,5 +1,6 @@
 #include "common.hpp"
 #include "operator_match_handler.hpp"
+#include "parser_stats.hpp"
 #include "type_helper.hpp"
 
 # if defined(__LLVM_VERSION_8)
@@ -14,6 +15,8 @@ OperatorMatchHandler::OperatorMatchHandler(Document &doc, const std::string &nam
 }
 
 void OperatorMatchHandler::run(const clang::ast_matchers::MatchFinder::MatchResult &result) {
+	ParserStats::instance().count("matches.operator");
+
 	const auto *op = result.Nodes.getNodeAs<clang::FunctionDecl>("operatorDecl");
 	if (!op) return;
 
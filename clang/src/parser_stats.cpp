@@ -0,0 +1,81 @@
+#include "common.hpp"
+#include "parser_stats.hpp"
+
+#include <fstream>
+#include <sys/resource.h>
+
+static llvm::cl::opt<std::string> StatsOut("stats-out", llvm::cl::desc("Write parser statistics as JSON into this file"), llvm::cl::value_desc("path"));
+
+static int64_t peakRss() {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+#ifdef __APPLE__
+	return static_cast<int64_t>(usage.ru_maxrss); // Bytes on macOS
+#else
+	return static_cast<int64_t>(usage.ru_maxrss) * 1024; // Kilobytes elsewhere
+#endif
+}
+
+ParserStats::ParserStats() {
+}
+
+ParserStats &ParserStats::instance() {
+	static ParserStats stats;
+	return stats;
+}
+
+bool ParserStats::isEnabled() const {
+	return !StatsOut.empty();
+}
+
+void ParserStats::begin(const std::string &name) {
+	if (!isEnabled()) return;
+
+	end();
+	this->m_current = name;
+	this->m_startRss = peakRss();
+	this->m_start = std::chrono::steady_clock::now();
+}
+
+void ParserStats::end() {
+	if (this->m_current.empty()) return;
+
+	auto duration = std::chrono::steady_clock::now() - this->m_start;
+	Phase &phase = this->m_phases[this->m_current];
+	phase.durationNs += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	phase.peakRss = peakRss();
+	phase.rssGrowth += phase.peakRss - this->m_startRss;
+
+	this->m_current.clear();
+}
+
+void ParserStats::count(const std::string &name, int64_t amount) {
+	if (!isEnabled()) return;
+	this->m_counters[name] += amount;
+}
+
+void ParserStats::write() {
+	if (!isEnabled()) return;
+	end();
+
+	std::ofstream file(StatsOut);
+	JsonStream stream(file);
+	auto c = JsonStream::Comma;
+
+	stream << JsonStream::ObjectBegin
+		<< std::make_pair("phases", this->m_phases) << c
+		<< std::make_pair("counters", this->m_counters)
+		<< JsonStream::ObjectEnd;
+	file << std::endl;
+}
+
+JsonStream &operator<<(JsonStream &s, const ParserStats::Phase &value) {
+	auto c = JsonStream::Comma;
+	s << JsonStream::ObjectBegin
+		<< std::make_pair("durationNs", value.durationNs) << c
+		<< std::make_pair("peakRss", value.peakRss) << c
+		<< std::make_pair("rssGrowth", value.rssGrowth)
+		<< JsonStream::ObjectEnd;
+	return s;
+}
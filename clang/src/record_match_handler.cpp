@@ -1,14 +1,21 @@
 #include "common.hpp"
 #include "record_match_handler.hpp"
+#include "parser_stats.hpp"
 #include "enum_match_handler.hpp"
 #include "type_helper.hpp"
+#include "symbol_helper.hpp"
 
-RecordMatchHandler::RecordMatchHandler(Document &doc, const std::string &name)
-	: m_document(doc), m_className(name)
+#include "clang/AST/RecordLayout.h"
+#include "clang/Sema/Sema.h"
+
+RecordMatchHandler::RecordMatchHandler(Document &doc, clang::CompilerInstance &compiler, const std::string &name)
+	: m_document(doc), m_compiler(compiler), m_className(name)
 {
 }
 
 void RecordMatchHandler::run(const clang::ast_matchers::MatchFinder::MatchResult &result) {
+	ParserStats::instance().count("matches.record");
+
 	const clang::CXXRecordDecl *record0 = result.Nodes.getNodeAs<clang::CXXRecordDecl>("recordDecl");
 	if (record0) {
 		m_classesToRun.push_back(std::make_pair(record0, this->m_className));
@@ -75,22 +82,25 @@ bool RecordMatchHandler::runOnMethod(Method &m, Class &klass, const clang::CXXMe
 	}
 
 	TypeHelper::addFunctionParameters(method, m);
+	SymbolHelper::addSymbol(method, m);
 	return true;
 }
 
 bool RecordMatchHandler::runOnRecord(Class &klass, const clang::CXXRecordDecl *record) {
-	const auto *typeInfoResult = m_document.findTypeInfoResult(klass.name);
-
-	klass.hasDefaultConstructor = record->hasDefaultConstructor() &&
-		!(typeInfoResult && !typeInfoResult->isDefaultConstructible);
+	klass.hasDefaultConstructor = isDefaultConstructible(record);
 	klass.hasCopyConstructor = record->hasCopyConstructorWithConstParam();
 	klass.isAbstract = record->isAbstract();
+	klass.isTriviallyCopyable = record->isTriviallyCopyable();
+	klass.isTriviallyDestructible = isTriviallyDestructible(record);
+	klass.isStandardLayout = record->isStandardLayout();
 	klass.typeKind = record->getTagKind();
 
 	clang::TypeInfo typeInfo = record->getASTContext().getTypeInfo(record->getTypeForDecl());
 	uint64_t bitSize = typeInfo.Width;
 	if (typeInfo.AlignIsRequired) bitSize += typeInfo.Align;
 	klass.byteSize = bitSize / 8;
+	klass.alignment = typeInfo.Align / 8;
+	klass.isPointerFree = isPointerFree(record);
 
 	for (clang::CXXBaseSpecifier base : record->bases()) {
 		klass.bases.push_back(handleBaseClass(base));
@@ -143,6 +153,71 @@ bool RecordMatchHandler::runOnRecord(Class &klass, const clang::CXXRecordDecl *r
 	return true;
 }
 
+// Mirrors `std::is_default_constructible`: Sema declares the implicit default
+// constructor if needed, and tells if it's deleted.
+bool RecordMatchHandler::isDefaultConstructible(const clang::CXXRecordDecl *record) {
+	if (record->isAbstract())
+		return false;
+
+	clang::Sema &sema = this->m_compiler.getSema();
+	auto *mutableRecord = const_cast<clang::CXXRecordDecl *>(record);
+
+	clang::CXXConstructorDecl *ctor = sema.LookupDefaultConstructor(mutableRecord);
+	if (!ctor || ctor->isDeleted() || ctor->getAccess() != clang::AS_public)
+		return false;
+
+	return hasPublicDestructor(record);
+}
+
+bool RecordMatchHandler::isTriviallyDestructible(const clang::CXXRecordDecl *record) {
+	// A trivial destructor can still be deleted or inaccessible.  Skipping it
+	// must not allow destroying what the C++ code itself couldn't.
+	return record->hasTrivialDestructor() && hasPublicDestructor(record);
+}
+
+bool RecordMatchHandler::hasPublicDestructor(const clang::CXXRecordDecl *record) {
+	clang::Sema &sema = this->m_compiler.getSema();
+	auto *mutableRecord = const_cast<clang::CXXRecordDecl *>(record);
+
+	clang::CXXDestructorDecl *dtor = sema.LookupDestructor(mutableRecord);
+	return !dtor || (!dtor->isDeleted() && dtor->getAccess() == clang::AS_public);
+}
+
+bool RecordMatchHandler::isPointerFree(const clang::CXXRecordDecl *record) {
+	if (!record->hasDefinition()) // Can't know, so assume the worst.
+		return false;
+
+	// Note: The vtable pointer of a dynamic class points into static storage,
+	// not into the GC heap.  It doesn't need to be scanned.
+	for (const clang::CXXBaseSpecifier &base : record->bases()) {
+		if (!isPointerFree(base.getType()))
+			return false;
+	}
+
+	for (const clang::FieldDecl *field : record->fields()) {
+		if (!isPointerFree(field->getType()))
+			return false;
+	}
+
+	return true;
+}
+
+bool RecordMatchHandler::isPointerFree(clang::QualType qt) {
+	qt = qt.getCanonicalType();
+
+	if (qt->isDependentType())
+		return false;
+
+	if (const clang::ArrayType *array = qt->getAsArrayTypeUnsafe())
+		return isPointerFree(array->getElementType());
+
+	if (const clang::CXXRecordDecl *record = qt->getAsCXXRecordDecl())
+		return isPointerFree(record);
+
+	// Everything else is either a pointer-like type, or a scalar.
+	return qt->isBuiltinType() || qt->isEnumeralType() || qt->isComplexType() || qt->isVectorType();
+}
+
 static void readDefaultValue(Field &f, const clang::ValueDecl *decl, const clang::Expr *init) {
 	if (init) {
 		f.hasDefault = true;
@@ -167,6 +242,12 @@ bool RecordMatchHandler::runOnField(Field &f, const clang::FieldDecl *field) {
 	TypeHelper::qualTypeToType(f, qt, ctx);
 	readDefaultValue(f, field, field->getInClassInitializer());
 
+	const clang::RecordDecl *parent = field->getParent();
+	if (!parent->isInvalidDecl() && !parent->isDependentType()) {
+		const clang::ASTRecordLayout &layout = ctx.getASTRecordLayout(parent);
+		f.offset = ctx.toCharUnitsFromBits(layout.getFieldOffset(field->getFieldIndex())).getQuantity();
+	}
+
 	return true;
 }
 
@@ -1,11 +1,20 @@
 #include <regex.hpp>
 
+#include <cctype>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
 
 static const int PCRE_FLAGS = 0;
 
+#ifdef PCRE_STUDY_JIT_COMPILE
+static const int PCRE_STUDY_FLAGS = PCRE_STUDY_JIT_COMPILE;
+#else
+static const int PCRE_STUDY_FLAGS = 0; // PCRE older than 8.20
+#endif
+
 static void errorAndBail(const char *message, const std::string &expression, const char *error, int offset) {
   fprintf(stderr, "%s:\n", message);
   fprintf(stderr, "  Error     : %s\n", error);
@@ -32,7 +41,7 @@ static void compileRegex(const std::string &expr, pcre *&regex, pcre_extra *&ext
     errorAndBail("Bad regular expression", expr, error, offset);
   }
 
-  extra = pcre_study(regex, 0, &error);
+  extra = pcre_study(regex, PCRE_STUDY_FLAGS, &error);
 
   if (error) { // m_extra can be NULL, and that's ok!
     errorAndBail("Failed to study expression", expr, error, -1);
@@ -41,17 +50,166 @@ static void compileRegex(const std::string &expr, pcre *&regex, pcre_extra *&ext
   pcre_refcount(regex, 1);
 }
 
+// How a top-level alternative of an expression can be matched.
+enum AlternativeKind {
+  Name, // `^literal$`
+  Prefix, // `^literal` or `^literal.*`
+  Partial, // `^literal` followed by anything else
+  Other, // Anything else
+};
+
+static bool isMetaCharacter(char c) {
+  return strchr("\\^$.|?*+()[]{}", c) != nullptr;
+}
+
+static bool isQuantifier(char c) {
+  return c == '?' || c == '*' || c == '+' || c == '{';
+}
+
+// Splits *expr* at its top-level `|`.  Returns `false` if the expression uses
+// anything which could change the meaning of other alternatives.
+static bool splitAlternatives(const std::string &expr, std::vector<std::string> &alternatives) {
+  if (expr.find("(?") != std::string::npos) return false; // Inline options
+
+  std::string current;
+  int depth = 0;
+  bool inClass = false;
+
+  for (size_t i = 0; i < expr.size(); i++) {
+    char c = expr[i];
+
+    if (c == '\\' && i + 1 < expr.size()) {
+      current += c;
+      current += expr[++i];
+      continue;
+    }
+
+    if (inClass) {
+      if (c == ']') inClass = false;
+    } else if (c == '[') {
+      inClass = true;
+      if (i + 1 < expr.size() && expr[i + 1] == ']') current += expr[++i]; // `[]...]`
+    } else if (c == '(') {
+      depth++;
+    } else if (c == ')') {
+      depth--;
+    } else if (c == '|' && depth == 0) {
+      alternatives.push_back(current);
+      current.clear();
+      continue;
+    }
+
+    current += c;
+  }
+
+  alternatives.push_back(current);
+  return depth == 0 && !inClass;
+}
+
+// Finds out how *alternative* can be matched, and stores its leading literal
+// into *literal*.
+static AlternativeKind parseAlternative(const std::string &alternative, std::string &literal) {
+  if (alternative.empty() || alternative[0] != '^') return Other;
+
+  size_t i = 1;
+  while (i < alternative.size()) {
+    char c = alternative[i];
+
+    if (c == '\\' && i + 1 < alternative.size() && !isalnum(alternative[i + 1])) {
+      literal += alternative[i + 1]; // Escaped meta character
+      i += 2;
+    } else if (!isMetaCharacter(c)) {
+      literal += c;
+      i++;
+    } else {
+      break;
+    }
+  }
+
+  std::string rest = alternative.substr(i);
+
+  // A quantifier applies to the last literal character.
+  if (!rest.empty() && isQuantifier(rest[0])) {
+    if (literal.empty()) return Other;
+    literal.pop_back();
+    return literal.empty() ? Other : Partial;
+  }
+
+  if (rest == "$") return Name;
+  if (rest.empty() || rest == ".*" || rest == ".*$") return Prefix;
+  return literal.empty() ? Other : Partial;
+}
+
+void LiteralSet::add(const std::string &literal) {
+  this->m_literals.insert(literal);
+  this->m_lengths.insert(literal.size());
+}
+
+bool LiteralSet::isEqual(const std::string &text) const {
+  return this->m_literals.find(text) != this->m_literals.end();
+}
+
+bool LiteralSet::isPrefixOf(const std::string &text) const {
+  for (size_t length : this->m_lengths) {
+    if (length > text.size()) break;
+    if (this->m_literals.find(text.substr(0, length)) != this->m_literals.end()) return true;
+  }
+
+  return false;
+}
+
 Regex::Regex(const std::string &expression)
   : m_regex(nullptr), m_extra(nullptr)
 {
   // If the expression is empty, we don't want to match anything.
   if (!expression.empty()) {
+    compile(expression);
+  }
+}
+
+void Regex::compile(const std::string &expression) {
+  std::vector<std::string> alternatives;
+  if (!splitAlternatives(expression, alternatives)) {
     compileRegex(expression, this->m_regex, this->m_extra);
+    return;
+  }
+
+  std::string remaining;
+  bool guarded = true;
+  LiteralSet guards;
+
+  for (const std::string &alternative : alternatives) {
+    std::string literal;
+    switch (parseAlternative(alternative, literal)) {
+    case Name:
+      this->m_names.add(literal);
+      continue;
+    case Prefix:
+      this->m_prefixes.add(literal);
+      continue;
+    case Partial:
+      guards.add(literal);
+      break;
+    case Other:
+      guarded = false;
+      break;
+    }
+
+    if (!remaining.empty()) remaining += '|';
+    remaining += alternative;
   }
+
+  if (remaining.empty()) return; // Everything is matched through the sets
+  if (guarded) this->m_guards = guards;
+
+  compileRegex(remaining, this->m_regex, this->m_extra);
 }
 
-Regex::Regex(const Regex &other) {
+Regex::Regex(const Regex &other)
+  : m_names(other.m_names), m_prefixes(other.m_prefixes), m_guards(other.m_guards)
+{
   this->m_regex = other.m_regex;
+  this->m_extra = other.m_extra;
 
   if (this->m_regex) {
     pcre_refcount(this->m_regex, 1);
@@ -66,8 +224,12 @@ Regex::~Regex() {
 }
 
 bool Regex::isMatch(const std::string &text) const {
+  if (this->m_names.isEqual(text) || this->m_prefixes.isPrefixOf(text)) return true;
   if (this->m_regex == nullptr) return false;
 
+  // Skip PCRE if none of its alternatives could match.
+  if (!this->m_guards.empty() && !this->m_guards.isPrefixOf(text)) return false;
+
   int r;
 
   r = pcre_exec(this->m_regex, this->m_extra, text.c_str(), text.size(), 0, 0, NULL, 0);
@@ -125,8 +125,15 @@ JsonStream &operator<<(JsonStream &s, const Method &value) {
 		<< std::make_pair("isVirtual", value.isVirtual) << c
 		<< std::make_pair("isPure", value.isPure) << c
 		<< std::make_pair("isExternC", value.isExternC) << c
+		<< std::make_pair("isExported", value.isExported) << c
 		<< std::make_pair("className", value.className) << c;
 
+	if (value.symbolName.empty()) {
+		s << std::make_pair("symbolName", JsonStream::Null) << c;
+	} else {
+		s << std::make_pair("symbolName", value.symbolName) << c;
+	}
+
 	if (value.firstDefaultArgument < 0) {
 		s << std::make_pair("firstDefaultArgument", JsonStream::Null) << c;
 	} else {
@@ -173,6 +180,8 @@ JsonStream &operator<<(JsonStream &s, const Field &value) {
 		s << std::make_pair("value", value.value) << c;
 	}
 
+	s << std::make_pair("offset", value.offset) << c;
+
 	if (value.bitField > 0)
 		s << std::make_pair("bitField", value.name);
 	else
@@ -198,10 +207,15 @@ JsonStream &operator<<(JsonStream &s, const Class &value) {
 		<< JsonStream::ObjectBegin
 		<< std::make_pair("name", value.name) << c
 		<< std::make_pair("byteSize", value.byteSize) << c
+		<< std::make_pair("alignment", value.alignment) << c
 		<< std::make_pair("typeKind", value.typeKind) << c
 		<< std::make_pair("isAbstract", value.isAbstract) << c
 		<< std::make_pair("isAnonymous", value.isAnonymous) << c
 		<< std::make_pair("isDestructible", value.isDestructible) << c
+		<< std::make_pair("isPointerFree", value.isPointerFree) << c
+		<< std::make_pair("isTriviallyCopyable", value.isTriviallyCopyable) << c
+		<< std::make_pair("isTriviallyDestructible", value.isTriviallyDestructible) << c
+		<< std::make_pair("isStandardLayout", value.isStandardLayout) << c
 		<< std::make_pair("hasDefaultConstructor", value.hasDefaultConstructor) << c
 		<< std::make_pair("hasCopyConstructor", value.hasCopyConstructor) << c
 		<< std::make_pair("bases", value.bases) << c
@@ -248,6 +262,25 @@ JsonStream &operator<<(JsonStream &s, const Document &value) {
 		<< std::make_pair("enums", value.enums) << c
 		<< std::make_pair("classes", value.classes) << c
 		<< std::make_pair("functions", value.functions) << c
-		<< std::make_pair("macros", value.macros)
+		<< std::make_pair("macros", value.macros) << c
+		<< std::make_pair("targets", value.targets)
+		<< JsonStream::ObjectEnd;
+}
+
+JsonStream &operator<<(JsonStream &s, const ClassLayout &value) {
+	auto c = JsonStream::Comma;
+	return s
+		<< JsonStream::ObjectBegin
+		<< std::make_pair("byteSize", value.byteSize) << c
+		<< std::make_pair("alignment", value.alignment)
+		<< JsonStream::ObjectEnd;
+}
+
+JsonStream &operator<<(JsonStream &s, const TargetLayout &value) {
+	auto c = JsonStream::Comma;
+	return s
+		<< JsonStream::ObjectBegin
+		<< std::make_pair("triple", value.triple) << c
+		<< std::make_pair("classes", value.classes)
 		<< JsonStream::ObjectEnd;
 }
@@ -0,0 +1,80 @@
+#include "symbol_helper.hpp"
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/GlobalDecl.h"
+#include "clang/AST/Mangle.h"
+#include "clang/Basic/TargetInfo.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+
+// Checks if any declaration of *func* is inline.  The matched declaration may
+// not be: A method can be declared in its class, and defined `inline` later.
+static bool isInlineAnywhere(const clang::FunctionDecl *func) {
+	for (const clang::FunctionDecl *decl : func->redecls()) {
+		if (decl->isInlined() || decl->isInlineSpecified())
+			return true;
+	}
+
+	return false;
+}
+
+// Checks if the library has to export a symbol for *func*.  This is the case
+// for functions with external linkage and default visibility, which are
+// neither inline nor templated, as these are only emitted where they're used.
+static bool isExported(const clang::FunctionDecl *func) {
+	if (isInlineAnywhere(func) || func->isConstexpr() || func->isDeleted() || func->isDefaulted())
+		return false;
+
+	if (func->isDependentContext() || func->isTemplateInstantiation())
+		return false;
+
+	if (const clang::CXXMethodDecl *method = llvm::dyn_cast<clang::CXXMethodDecl>(func)) {
+		if (method->getParent()->getTemplateSpecializationKind() != clang::TSK_Undeclared)
+			return false; // Member of a class template
+	}
+
+	return func->hasExternalFormalLinkage() && func->getVisibility() == clang::DefaultVisibility;
+}
+
+// Mangles the name of *func*.  Returns an empty string for ABIs other than
+// Itanium, where `this` isn't passed like a first argument.  The mangle context
+// is created per call, as the AST context of each target run is destroyed once
+// the run is done.
+static std::string mangledName(const clang::FunctionDecl *func) {
+	clang::ASTContext &ctx = func->getASTContext();
+	if (!ctx.getTargetInfo().getCXXABI().isItaniumFamily())
+		return std::string();
+
+	std::unique_ptr<clang::MangleContext> mangler(ctx.createMangleContext());
+
+	std::string name;
+	llvm::raw_string_ostream stream(name);
+
+# if __clang_major__ < 11
+	mangler->mangleName(func, stream);
+# else
+	mangler->mangleName(clang::GlobalDecl(func), stream);
+# endif
+
+	stream.flush();
+	return name;
+}
+
+void SymbolHelper::addSymbol(const clang::FunctionDecl *func, Method &m) {
+	// Constructors and destructors have multiple symbols, and virtual methods
+	// have to go through the vtable.
+	if (llvm::isa<clang::CXXConstructorDecl>(func) || llvm::isa<clang::CXXDestructorDecl>(func))
+		return;
+
+	if (const clang::CXXMethodDecl *method = llvm::dyn_cast<clang::CXXMethodDecl>(func)) {
+		if (method->isVirtual()) return;
+	}
+
+	if (func->isExternC() || func->isInExternCContext() || !isExported(func))
+		return;
+
+	m.symbolName = mangledName(func);
+	m.isExported = !m.symbolName.empty();
+}
@@ -0,0 +1,99 @@
+#include "common.hpp"
+#include "target_layouts.hpp"
+
+#include <cerrno>
+#include <unistd.h>
+
+TargetLayouts &TargetLayouts::instance() {
+	static TargetLayouts layouts;
+	return layouts;
+}
+
+void TargetLayouts::beginSecondary(const std::string &triple, int fd) {
+	this->m_current = triple;
+	this->m_output = fd;
+}
+
+void TargetLayouts::beginPrimary() {
+	this->m_current.clear();
+	this->m_output = -1;
+}
+
+bool TargetLayouts::isSecondary() const {
+	return !this->m_current.empty();
+}
+
+// The report has a line per class: Its size, alignment and name.
+void TargetLayouts::addSecondary(const std::string &triple, const std::string &report) {
+	TargetLayout layout;
+	layout.triple = triple;
+
+	std::istringstream lines(report);
+	std::string line;
+	while (std::getline(lines, line)) {
+		std::istringstream fields(line);
+		ClassLayout classLayout;
+		std::string name;
+
+		fields >> classLayout.byteSize >> classLayout.alignment >> std::ws;
+		std::getline(fields, name); // Template names contain spaces.
+		if (!name.empty()) layout.classes[name] = classLayout;
+	}
+
+	this->m_secondaries.push_back(layout);
+}
+
+void TargetLayouts::finishTarget(Document &doc) {
+	if (isSecondary()) {
+		std::ostringstream report;
+		TargetLayout layout = layoutOf(doc);
+
+		for (const std::string &name : layout.classes.keys()) {
+			const ClassLayout &klass = *layout.classes.at(name);
+			report << klass.byteSize << ' ' << klass.alignment << ' ' << name << '\n';
+		}
+
+		std::string text = report.str();
+		for (size_t done = 0; done < text.size(); ) {
+			ssize_t written = write(this->m_output, text.data() + done, text.size() - done);
+			if (written < 0 && errno != EINTR) break;
+			if (written > 0) done += written;
+		}
+
+		return;
+	}
+
+	TargetLayout primary = layoutOf(doc);
+	for (const TargetLayout &secondary : this->m_secondaries) {
+		doc.targets.push_back(difference(primary, secondary));
+	}
+}
+
+TargetLayout TargetLayouts::layoutOf(const Document &doc) {
+	TargetLayout layout;
+
+	for (const std::string &name : doc.classes.keys()) {
+		const Class &klass = *doc.classes.at(name);
+		ClassLayout &classLayout = layout.classes[name];
+		classLayout.byteSize = klass.byteSize;
+		classLayout.alignment = klass.alignment;
+	}
+
+	return layout;
+}
+
+TargetLayout TargetLayouts::difference(const TargetLayout &primary, const TargetLayout &secondary) {
+	TargetLayout result;
+	result.triple = secondary.triple;
+
+	for (const std::string &name : secondary.classes.keys()) {
+		const ClassLayout &theirs = *secondary.classes.at(name);
+		const ClassLayout *ours = primary.classes.at(name);
+
+		if (!ours || ours->byteSize != theirs.byteSize || ours->alignment != theirs.alignment) {
+			result.classes[name] = theirs;
+		}
+	}
+
+	return result;
+}
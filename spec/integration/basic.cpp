@@ -125,6 +125,13 @@ int operator--(FreeOps &) { return 10007; }
 int operator++(FreeOps &, int) { return 10008; }
 int operator--(FreeOps &, int) { return 10009; }
 
+class SlotValue {
+  int v;
+public:
+  SlotValue(int v) : v(v) { }
+  int value() const { return v; }
+};
+
 class TypeConversion {
 public:
 
@@ -144,6 +151,17 @@ public:
   void *voidPointer() {
     return reinterpret_cast<void *>(0x11223344); // Don't break on 32bit!
   }
+
+  // Constructed into the return slot of the Crystal wrapper.
+  SlotValue slotValue(int v) {
+    return SlotValue(v);
+  }
+
+  // Bound with the argument moved into the callee.
+  int consumeSlotValue(SlotValue &&v) {
+    SlotValue taken(static_cast<SlotValue &&>(v));
+    return taken.value();
+  }
 };
 
 struct ImplicitConstructor {
@@ -162,3 +180,14 @@ class PrivateConstructor {
 struct DeletedConstructor {
   DeletedConstructor() = delete;
 };
+
+// Only types with a destructor to run get a finalizer, see `CrystalGCWrapper`.
+class Finalized {
+public:
+  ~Finalized() { }
+};
+
+#ifdef BINDGEN_HELPER_HPP
+static_assert(!std::is_base_of<gc_cleanup, CrystalGCWrapper<Adder>>::value, "Adder registers a finalizer");
+static_assert(std::is_base_of<gc_cleanup, CrystalGCWrapper<Finalized>>::value, "Finalized registers no finalizer");
+#endif
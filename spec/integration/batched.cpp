@@ -0,0 +1,37 @@
+/* Note: Used by `batched_spec.cr` and `benchmark/ffi/batched.cr`. */
+
+class Canvas {
+public:
+  enum Mode { Add, Subtract };
+
+  Canvas() : sum(0), points(0) { }
+
+  // Batched.
+  void drawPoint(int x, int y) {
+    sum += x * 100 + y;
+    points++;
+  }
+
+  void drawScaled(int x, double scale, Mode mode) {
+    int value = (int)(x * scale);
+    sum += (mode == Add) ? value : -value;
+    points++;
+  }
+
+  void drawCanvas(Canvas *other) {
+    sum += other->sum;
+    points++;
+  }
+
+  // Not batched: Same as `drawPoint`, but called right away.
+  void plotPoint(int x, int y) {
+    drawPoint(x, y);
+  }
+
+  int total() const { return sum; }
+  int count() const { return points; }
+
+private:
+  int sum;
+  int points;
+};
@@ -0,0 +1,23 @@
+#include <string>
+
+class Collapsed {
+  int base;
+public:
+  Collapsed(int b = 1, std::string name = "none") : base(b + name.length()) { }
+
+  int sum(int a, std::string b = "ab") {
+    return this->base + a + b.length();
+  }
+
+  static int twice(int a = 4, std::string b = "") {
+    return (a + b.length()) * 2;
+  }
+
+  void reset(std::string name = "") {
+    this->base = name.length();
+  }
+
+  int get() const {
+    return this->base;
+  }
+};
@@ -0,0 +1,15 @@
+// Methods defined out-of-line are bound to their symbol directly.  Methods
+// defined `inline` after the class have no symbol, and keep their wrapper.
+class Calculator {
+public:
+  int twice(int x);
+  int thrice(int x);
+};
+
+int Calculator::twice(int x) {
+  return x * 2;
+}
+
+inline int Calculator::thrice(int x) {
+  return x * 3;
+}
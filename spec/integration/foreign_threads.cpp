@@ -0,0 +1,79 @@
+#include <atomic>
+#include <thread>
+
+// Returned by reference from a virtual method.
+class Label {
+public:
+  Label(int value) : m_value(value) { }
+
+  int value() const {
+    return m_value;
+  }
+
+private:
+  int m_value;
+};
+
+// Calls its virtual methods from threads created in C++.
+class Job {
+public:
+  virtual ~Job() {
+    if (m_thread.joinable()) m_thread.join();
+  }
+
+  virtual int compute(int x) {
+    return x;
+  }
+
+  virtual const Label &label() {
+    return m_label;
+  }
+
+  // Calls `label` twice on a new thread, and checks that both calls refer to
+  // the same object.  Returns its value, or -1 if they don't.
+  int labelOnThread() {
+    int result = 0;
+    std::thread thread([this, &result]() {
+      const Label &first = label();
+      const Label &second = label();
+      result = (&first == &second) ? first.value() : -1;
+    });
+    thread.join();
+
+    return result;
+  }
+
+  // Calls `compute` on a new thread, and waits for it.
+  int runOnThread(int x) {
+    int result = 0;
+    std::thread thread([this, x, &result]() { result = compute(x); });
+    thread.join();
+
+    return result;
+  }
+
+  // Calls `compute` on a new thread, without waiting for it.
+  void startOnThread(int x) {
+    m_done = false;
+    m_thread = std::thread([this, x]() {
+      m_result = compute(x);
+      m_done = true;
+    });
+  }
+
+  bool isDone() const {
+    return m_done;
+  }
+
+  // Waits for the thread started by `startOnThread`, and returns its result.
+  int finish() {
+    m_thread.join();
+    return m_result;
+  }
+
+private:
+  std::thread m_thread;
+  std::atomic<bool> m_done{ false };
+  int m_result = 0;
+  Label m_label{ 0 };
+};
@@ -0,0 +1,7 @@
+// Wrappers of this class are profiled, see `bindgen_helper.hpp`.
+class Counter {
+public:
+  int add(int x) {
+    return x + 1;
+  }
+};
@@ -1,25 +1,60 @@
 // Allow these tests to run without a real Qt installation.  Provide mocks for
 // those features we require.
 
+#include <functional>
+#include <vector>
+
 #define signals public
 #define Q_GADGET void qt_check_for_QGADGET_macro();
 #define Q_OBJECT class QPrivateSignal { };
 
+namespace Qt {
+  enum ConnectionType { QueuedConnection };
+}
+
 struct QMetaObject {
   struct Connection {
     // Do nothing.
   };
+
+  // Calls queued by `invokeMethod`, run by `QCoreApplication::processEvents`.
+  static std::vector<std::function<void()>> &queued() {
+    static std::vector<std::function<void()>> calls;
+    return calls;
+  }
+
+  template< typename F >
+  static bool invokeMethod(void *context, F function, Qt::ConnectionType type) {
+    queued().push_back(function);
+    return true;
+  }
 };
 
 struct QObject {
   template< typename R, typename T, typename... Args, typename F >
   static QMetaObject::Connection connect(void *ptr, R (T::*func)(Args...), F delegate) {
-    delegate(Args { }...); // Call back to Crystal
+    // Call back to Crystal.  Emit twice, for coalesced connections to have
+    // something to coalesce.
+    delegate(Args { }...);
+    delegate(Args { }...);
 
     return QMetaObject::Connection();
   }
 };
 
+class QCoreApplication {
+public:
+  // Runs the queued calls, like an iteration of the event loop.
+  static void processEvents() {
+    std::vector<std::function<void()>> calls;
+    calls.swap(QMetaObject::queued());
+
+    for (auto &call : calls) {
+      call();
+    }
+  }
+};
+
 // Test object conversion at Proc boundaries
 struct Conv {
 };